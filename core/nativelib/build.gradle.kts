@@ -1,9 +1,50 @@
+import org.gradle.process.ExecOperations
+import javax.inject.Inject
+
 plugins {
     alias(libs.plugins.android.library)
     alias(libs.plugins.kotlin.android)
     alias(libs.plugins.kotlin.serialization)
 }
 
+// Compiles every src/main/watchlists/<category>.txt into one memory-mappable
+// watchlist.bin asset (see BundledWatchlist), using the host-side
+// wiredeye_watchlist_compiler from src/main/cpp. Needs a host C++ compiler.
+abstract class CompileWatchlistsTask : DefaultTask() {
+    @get:InputFile
+    @get:PathSensitive(PathSensitivity.NONE)
+    abstract val compiler: RegularFileProperty
+
+    @get:InputDirectory
+    @get:PathSensitive(PathSensitivity.RELATIVE)
+    abstract val listDir: DirectoryProperty
+
+    @get:OutputDirectory
+    abstract val outputDir: DirectoryProperty
+
+    @get:Inject
+    abstract val execOperations: ExecOperations
+
+    @TaskAction
+    fun compile() {
+        val out = outputDir.get().asFile.apply {
+            deleteRecursively()
+            mkdirs()
+        }
+        val lists = listDir.get().asFile
+            .listFiles { file -> file.extension == "txt" }
+            .orEmpty()
+            .sortedBy { it.name }
+        if (lists.isEmpty()) return
+
+        execOperations.exec {
+            executable = compiler.get().asFile.absolutePath
+            args(File(out, "watchlist.bin").absolutePath)
+            lists.forEach { args("${it.nameWithoutExtension}=${it.absolutePath}") }
+        }
+    }
+}
+
 android {
     namespace = "com.muratcangzm.core.nativelib"
     compileSdk {
@@ -64,4 +105,49 @@ dependencies {
     implementation(libs.androidx.core.ktx)
     implementation(libs.kotlinx.serialization.json)
     implementation(libs.kotlinx.serialization.core)
-}
\ No newline at end of file
+    testImplementation(libs.junit)
+}
+
+val hostToolsDir = layout.buildDirectory.dir("host-tools")
+val sdkCmakeBin = androidComponents.sdkComponents.sdkDirectory.map {
+    it.dir("cmake/${libs.versions.cmake.get()}/bin").asFile
+}
+val hostExecutableSuffix = if (System.getProperty("os.name").startsWith("Windows")) ".exe" else ""
+
+val configureWatchlistCompiler by tasks.registering(Exec::class) {
+    inputs.file("src/main/cpp/CMakeLists.txt")
+    outputs.file(hostToolsDir.map { it.file("CMakeCache.txt") })
+    doFirst {
+        val bin = sdkCmakeBin.get()
+        executable = File(bin, "cmake$hostExecutableSuffix").takeIf { it.exists() }?.absolutePath ?: "cmake"
+        val ninja = File(bin, "ninja$hostExecutableSuffix")
+        if (ninja.exists()) args("-G", "Ninja", "-DCMAKE_MAKE_PROGRAM=${ninja.absolutePath}")
+    }
+    args(
+        "-S", file("src/main/cpp").absolutePath,
+        "-B", hostToolsDir.get().asFile.absolutePath,
+        "-DCMAKE_BUILD_TYPE=Release"
+    )
+}
+
+val buildWatchlistCompiler by tasks.registering(Exec::class) {
+    dependsOn(configureWatchlistCompiler)
+    inputs.dir("src/main/cpp")
+    outputs.file(hostToolsDir.map { it.file("wiredeye_watchlist_compiler$hostExecutableSuffix") })
+    doFirst {
+        executable = File(sdkCmakeBin.get(), "cmake$hostExecutableSuffix").takeIf { it.exists() }?.absolutePath ?: "cmake"
+    }
+    args("--build", hostToolsDir.get().asFile.absolutePath, "--target", "wiredeye_watchlist_compiler")
+}
+
+val compileWatchlists by tasks.registering(CompileWatchlistsTask::class) {
+    dependsOn(buildWatchlistCompiler)
+    compiler.set(hostToolsDir.map { it.file("wiredeye_watchlist_compiler$hostExecutableSuffix") })
+    listDir.set(layout.projectDirectory.dir("src/main/watchlists"))
+}
+
+androidComponents {
+    onVariants { variant ->
+        variant.sources.assets?.addGeneratedSourceDirectory(compileWatchlists, CompileWatchlistsTask::outputDir)
+    }
+}
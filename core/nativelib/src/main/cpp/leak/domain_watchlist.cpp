@@ -0,0 +1,324 @@
+#include "domain_watchlist.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#include "leak_analyzer.h"
+
+namespace {
+
+    static void setError(std::string* error, const char* msg) {
+        if (error) *error = msg;
+    }
+
+    static std::string_view trim(std::string_view s) {
+        while (!s.empty() && static_cast<unsigned char>(s.front()) <= 0x20) s.remove_prefix(1);
+        while (!s.empty() && static_cast<unsigned char>(s.back()) <= 0x20) s.remove_suffix(1);
+        return s;
+    }
+
+    static bool isRuleChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.';
+    }
+
+    static bool addDomainRule(std::string_view token, bool suffix, std::vector<WatchlistRule>& out) {
+        if (token.rfind("*.", 0) == 0) {
+            token.remove_prefix(2);
+            suffix = true;
+        } else if (!token.empty() && token.front() == '.') {
+            token.remove_prefix(1);
+            suffix = true;
+        }
+
+        std::string domain = LeakAnalyzer::normalizeDomain(std::string(token));
+        if (domain.empty() || domain.find('.') == std::string::npos) return false;
+        if (!std::all_of(domain.begin(), domain.end(), isRuleChar)) return false;
+
+        out.push_back(WatchlistRule{.domain = std::move(domain), .suffix = suffix});
+        return true;
+    }
+
+} // namespace
+
+DomainWatchlist::DomainWatchlist(void* base, size_t size) : base_(base), size_(size) {
+    const auto* bytes = static_cast<const uint8_t*>(base);
+    header_ = reinterpret_cast<const WatchlistHeader*>(bytes);
+    nodes_ = reinterpret_cast<const WatchlistNode*>(bytes + sizeof(WatchlistHeader));
+    edges_ = reinterpret_cast<const WatchlistEdge*>(nodes_ + header_->nodeCount);
+    categories_ = reinterpret_cast<const WatchlistCategory*>(edges_ + header_->edgeCount);
+    pool_ = reinterpret_cast<const char*>(categories_ + header_->categoryCount);
+}
+
+DomainWatchlist::~DomainWatchlist() {
+    if (base_) munmap(base_, size_);
+}
+
+std::shared_ptr<const DomainWatchlist> DomainWatchlist::open(const std::string& path, std::string* error) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        setError(error, "cannot open watchlist");
+        return nullptr;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(WatchlistHeader))) {
+        close(fd);
+        setError(error, "watchlist too small");
+        return nullptr;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        setError(error, "mmap failed");
+        return nullptr;
+    }
+
+    const auto* header = static_cast<const WatchlistHeader*>(base);
+    const uint64_t tables =
+            sizeof(WatchlistHeader) +
+            static_cast<uint64_t>(header->nodeCount) * sizeof(WatchlistNode) +
+            static_cast<uint64_t>(header->edgeCount) * sizeof(WatchlistEdge) +
+            static_cast<uint64_t>(header->categoryCount) * sizeof(WatchlistCategory);
+    if (std::memcmp(header->magic, WATCHLIST_MAGIC, sizeof(WATCHLIST_MAGIC)) != 0 ||
+        header->version != WATCHLIST_VERSION ||
+        header->nodeCount == 0 ||
+        tables + header->poolSize != size) {
+        munmap(base, size);
+        setError(error, "bad watchlist header");
+        return nullptr;
+    }
+
+    std::shared_ptr<const DomainWatchlist> list(new DomainWatchlist(base, size));
+    if (!list->validate(error)) return nullptr;
+    return list;
+}
+
+bool DomainWatchlist::validate(std::string* error) const {
+    const uint32_t nodeCount = header_->nodeCount;
+    const uint32_t edgeCount = header_->edgeCount;
+    const uint32_t categoryCount = header_->categoryCount;
+    const uint64_t poolSize = header_->poolSize;
+
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        const auto& n = nodes_[i];
+        if (static_cast<uint64_t>(n.firstEdge) + n.edgeCount > edgeCount ||
+            n.exactCategory > categoryCount ||
+            n.suffixCategory > categoryCount) {
+            setError(error, "bad watchlist node");
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < edgeCount; i++) {
+        const auto& e = edges_[i];
+        if (static_cast<uint64_t>(e.labelOffset) + e.labelLength > poolSize || e.child >= nodeCount) {
+            setError(error, "bad watchlist edge");
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < categoryCount; i++) {
+        const auto& c = categories_[i];
+        if (static_cast<uint64_t>(c.nameOffset) + c.nameLength > poolSize) {
+            setError(error, "bad watchlist category");
+            return false;
+        }
+    }
+    return true;
+}
+
+int32_t DomainWatchlist::findChild(const WatchlistNode& node, std::string_view label) const {
+    const WatchlistEdge* first = edges_ + node.firstEdge;
+    const WatchlistEdge* last = first + node.edgeCount;
+    const WatchlistEdge* it = std::lower_bound(first, last, label, [this](const WatchlistEdge& e, std::string_view l) {
+        return std::string_view(pool_ + e.labelOffset, e.labelLength) < l;
+    });
+    if (it == last || std::string_view(pool_ + it->labelOffset, it->labelLength) != label) return -1;
+    return static_cast<int32_t>(it->child);
+}
+
+int32_t DomainWatchlist::match(std::string_view domain) const {
+    int32_t best = -1;
+    uint32_t node = 0;
+    size_t end = domain.size();
+
+    while (end > 0) {
+        const size_t dot = domain.rfind('.', end - 1);
+        const size_t start = (dot == std::string_view::npos) ? 0 : dot + 1;
+
+        const int32_t child = findChild(nodes_[node], domain.substr(start, end - start));
+        if (child < 0) break;
+        node = static_cast<uint32_t>(child);
+
+        const auto& n = nodes_[node];
+        if (start == 0 && n.exactCategory) return n.exactCategory - 1;
+        if (n.suffixCategory) best = n.suffixCategory - 1;
+
+        if (start == 0) break;
+        end = start - 1;
+    }
+    return best;
+}
+
+std::string_view DomainWatchlist::categoryName(int32_t category) const {
+    if (category < 0 || category >= categoryCount()) return {};
+    const auto& c = categories_[category];
+    return {pool_ + c.nameOffset, c.nameLength};
+}
+
+int32_t parseWatchlistRules(std::string_view line, std::vector<WatchlistRule>& out) {
+    // Element-hiding / scriptlet rules ("example.org##.banner") are not domain rules.
+    for (const char* cosmetic : {"##", "#@#", "#?#", "#$#"}) {
+        if (line.find(cosmetic) != std::string_view::npos) return 0;
+    }
+
+    // '#' starts a comment only at line start or after whitespace.
+    for (size_t i = 0; i < line.size(); i++) {
+        if (line[i] == '#' && (i == 0 || static_cast<unsigned char>(line[i - 1]) <= 0x20)) {
+            line = line.substr(0, i);
+            break;
+        }
+    }
+    line = trim(line);
+    if (line.empty() || line.front() == '!' || line.front() == '[') return 0;
+
+    if (line.rfind("||", 0) == 0) {
+        line.remove_prefix(2);
+        return addDomainRule(line.substr(0, line.find_first_of("^$/")), true, out) ? 1 : 0;
+    }
+
+    // hosts format: "0.0.0.0 ads.example.com [more names...]"
+    std::vector<std::string_view> tokens;
+    while (!line.empty()) {
+        const size_t sep = line.find_first_of(" \t");
+        tokens.push_back(line.substr(0, sep));
+        line = (sep == std::string_view::npos) ? std::string_view() : trim(line.substr(sep));
+    }
+
+    int32_t added = 0;
+    for (size_t i = (tokens.size() > 1) ? 1 : 0; i < tokens.size(); i++) {
+        if (addDomainRule(tokens[i], false, out)) added += 1;
+    }
+    return added;
+}
+
+DomainWatchlistBuilder::DomainWatchlistBuilder() : nodes_(1) {}
+
+int32_t DomainWatchlistBuilder::addCategory(const std::string& name) {
+    for (size_t i = 0; i < categories_.size(); i++) {
+        if (categories_[i] == name) return static_cast<int32_t>(i);
+    }
+    if (static_cast<int32_t>(categories_.size()) >= WATCHLIST_MAX_CATEGORIES) return -1;
+    categories_.push_back(name);
+    return static_cast<int32_t>(categories_.size()) - 1;
+}
+
+void DomainWatchlistBuilder::addRule(int32_t category, const WatchlistRule& rule) {
+    if (category < 0 || category >= static_cast<int32_t>(categories_.size())) return;
+
+    int32_t node = 0;
+    size_t end = rule.domain.size();
+    while (end > 0) {
+        const size_t dot = rule.domain.rfind('.', end - 1);
+        const size_t start = (dot == std::string::npos) ? 0 : dot + 1;
+        std::string label = rule.domain.substr(start, end - start);
+
+        auto it = nodes_[node].children.find(label);
+        if (it == nodes_[node].children.end()) {
+            const int32_t child = static_cast<int32_t>(nodes_.size());
+            nodes_[node].children.emplace(std::move(label), child);
+            nodes_.emplace_back();
+            node = child;
+        } else {
+            node = it->second;
+        }
+
+        if (start == 0) break;
+        end = start - 1;
+    }
+
+    // First list to claim a node keeps it.
+    uint16_t& slot = rule.suffix ? nodes_[node].suffixCategory : nodes_[node].exactCategory;
+    if (slot == 0) slot = static_cast<uint16_t>(category + 1);
+    rules_ += 1;
+}
+
+std::vector<uint8_t> DomainWatchlistBuilder::build() const {
+    // Breadth-first renumbering keeps each node's children contiguous.
+    std::vector<int32_t> order;
+    std::vector<uint32_t> newIndex(nodes_.size(), 0);
+    order.reserve(nodes_.size());
+    order.push_back(0);
+    for (size_t i = 0; i < order.size(); i++) {
+        for (const auto& kv : nodes_[order[i]].children) {
+            newIndex[kv.second] = static_cast<uint32_t>(order.size());
+            order.push_back(kv.second);
+        }
+    }
+
+    std::string pool;
+    std::unordered_map<std::string, uint32_t> poolIndex;
+    const auto intern = [&](const std::string& s) {
+        auto it = poolIndex.find(s);
+        if (it != poolIndex.end()) return it->second;
+        const uint32_t off = static_cast<uint32_t>(pool.size());
+        pool.append(s);
+        poolIndex.emplace(s, off);
+        return off;
+    };
+
+    std::vector<WatchlistNode> nodes;
+    std::vector<WatchlistEdge> edges;
+    nodes.reserve(order.size());
+    edges.reserve(order.size() - 1);
+    for (const int32_t id : order) {
+        const Node& n = nodes_[id];
+        nodes.push_back(WatchlistNode{
+                .firstEdge = static_cast<uint32_t>(edges.size()),
+                .edgeCount = static_cast<uint32_t>(n.children.size()),
+                .exactCategory = n.exactCategory,
+                .suffixCategory = n.suffixCategory
+        });
+        for (const auto& kv : n.children) {
+            edges.push_back(WatchlistEdge{
+                    .labelOffset = intern(kv.first),
+                    .labelLength = static_cast<uint32_t>(kv.first.size()),
+                    .child = newIndex[kv.second]
+            });
+        }
+    }
+
+    std::vector<WatchlistCategory> categories;
+    categories.reserve(categories_.size());
+    for (const auto& name : categories_) {
+        categories.push_back(WatchlistCategory{
+                .nameOffset = intern(name),
+                .nameLength = static_cast<uint32_t>(name.size())
+        });
+    }
+
+    WatchlistHeader header{};
+    std::memcpy(header.magic, WATCHLIST_MAGIC, sizeof(WATCHLIST_MAGIC));
+    header.version = WATCHLIST_VERSION;
+    header.nodeCount = static_cast<uint32_t>(nodes.size());
+    header.edgeCount = static_cast<uint32_t>(edges.size());
+    header.categoryCount = static_cast<uint32_t>(categories.size());
+    header.poolSize = static_cast<uint32_t>(pool.size());
+
+    std::vector<uint8_t> out;
+    const auto append = [&out](const void* data, size_t len) {
+        const auto* p = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), p, p + len);
+    };
+    append(&header, sizeof(header));
+    append(nodes.data(), nodes.size() * sizeof(WatchlistNode));
+    append(edges.data(), edges.size() * sizeof(WatchlistEdge));
+    append(categories.data(), categories.size() * sizeof(WatchlistCategory));
+    append(pool.data(), pool.size());
+    return out;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compiled domain watchlist: a reversed-label trie ("com" -> "example" -> "ads")
+// serialized into a flat, position-independent file that is memory-mapped at
+// runtime. Layout (native endianness, all fields uint32 unless noted):
+//
+//   WatchlistHeader
+//   WatchlistNode[nodeCount]         node 0 is the root
+//   WatchlistEdge[edgeCount]         children of a node are contiguous, sorted by label
+//   WatchlistCategory[categoryCount]
+//   char pool[poolSize]              labels and category names
+//
+// Exact rules match only the domain itself. Suffix rules ("*.example.com",
+// "||example.com^", ".example.com") match the domain and all of its subdomains.
+// The deepest matching rule wins; on the same node an exact rule beats a suffix rule.
+
+struct WatchlistHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t edgeCount;
+    uint32_t categoryCount;
+    uint32_t poolSize;
+};
+
+struct WatchlistNode {
+    uint32_t firstEdge;
+    uint32_t edgeCount;
+    uint16_t exactCategory;  // category index + 1, 0 = none
+    uint16_t suffixCategory; // category index + 1, 0 = none
+};
+
+struct WatchlistEdge {
+    uint32_t labelOffset;
+    uint32_t labelLength;
+    uint32_t child;
+};
+
+struct WatchlistCategory {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+
+inline constexpr char WATCHLIST_MAGIC[4] = {'W', 'E', 'W', 'L'};
+inline constexpr uint32_t WATCHLIST_VERSION = 1;
+inline constexpr int32_t WATCHLIST_MAX_CATEGORIES = 0xFFFE;
+
+class DomainWatchlist {
+public:
+    // Maps and validates a compiled watchlist file. Returns nullptr and fills
+    // `error` (if given) when the file cannot be read or is malformed.
+    static std::shared_ptr<const DomainWatchlist> open(const std::string& path, std::string* error);
+
+    ~DomainWatchlist();
+
+    DomainWatchlist(const DomainWatchlist&) = delete;
+    DomainWatchlist& operator=(const DomainWatchlist&) = delete;
+
+    // Returns the category index of the best rule matching a normalized
+    // domain, or -1. Cost is proportional to the number of labels.
+    int32_t match(std::string_view domain) const;
+
+    int32_t categoryCount() const { return static_cast<int32_t>(header_->categoryCount); }
+    std::string_view categoryName(int32_t category) const;
+
+private:
+    DomainWatchlist(void* base, size_t size);
+
+    bool validate(std::string* error) const;
+    int32_t findChild(const WatchlistNode& node, std::string_view label) const;
+
+    void* base_;
+    size_t size_;
+
+    const WatchlistHeader* header_;
+    const WatchlistNode* nodes_;
+    const WatchlistEdge* edges_;
+    const WatchlistCategory* categories_;
+    const char* pool_;
+};
+
+struct WatchlistRule {
+    std::string domain;
+    bool suffix = false;
+};
+
+// Parses one line of a plain, hosts-style or adblock-style domain list and
+// appends its rules to `out`. Returns the number of rules added, 0 for blank
+// lines, comments, cosmetic filters and unsupported syntax.
+int32_t parseWatchlistRules(std::string_view line, std::vector<WatchlistRule>& out);
+
+// Offline side of the format, used by the host-only watchlist compiler.
+class DomainWatchlistBuilder {
+public:
+    DomainWatchlistBuilder();
+
+    // Returns the category index, or -1 when the category limit is reached.
+    int32_t addCategory(const std::string& name);
+    void addRule(int32_t category, const WatchlistRule& rule);
+
+    int64_t ruleCount() const { return rules_; }
+    std::vector<uint8_t> build() const;
+
+private:
+    struct Node {
+        std::map<std::string, int32_t> children;
+        uint16_t exactCategory = 0;
+        uint16_t suffixCategory = 0;
+    };
+
+    std::vector<Node> nodes_;
+    std::vector<std::string> categories_;
+    int64_t rules_ = 0;
+};
@@ -1,11 +1,17 @@
 #include "leak_analyzer.h"
+#include "domain_watchlist.h"
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <mutex>
 #include <sstream>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace {
 
@@ -16,22 +22,140 @@ namespace {
         bool isPublicDns;
         bool isEntropySuspicious;
         bool isBurst;
+        int32_t listId;
+        int32_t weight;
     };
 
-    struct DomainAgg {
-        int64_t count = 0;
-        int64_t entropySuspicious = 0;
-        int64_t burst = 0;
-        std::deque<int64_t> recentTs;
-    };
+    static constexpr int64_t BURST_WINDOW_MS = 2500;
+    static constexpr int32_t BURST_THRESHOLD = 10;
+    static constexpr int32_t BURST_SLOTS = 10;
+    static constexpr int64_t BURST_SLOT_MS = BURST_WINDOW_MS / BURST_SLOTS;
+    static constexpr int64_t BURST_EPOCH_NONE = INT64_MIN;
+
+    static constexpr int32_t LIST_NONE = -1;
+    static constexpr int32_t LIST_UNKNOWN = -2;
+
+    // Load shedding: above budget only domains whose hash has the low
+    // `samplingShift` bits clear are kept, each event weighted 2^shift.
+    static constexpr int64_t DEFAULT_MAX_MEMORY_BYTES = 16LL * 1024 * 1024;
+    static constexpr int64_t DEFAULT_MAX_EVENTS_PER_SEC = 2000;
+    static constexpr int32_t MAX_SAMPLING_SHIFT = 6;
+    static constexpr int64_t SAMPLING_WINDOW_MS = 1000;
+    static constexpr int64_t SAMPLING_COOLDOWN_MS = 250;
+    static constexpr int64_t DOMAIN_OVERHEAD_BYTES = 160;
+    static constexpr int64_t CAP_CUTOFF_NONE = INT64_MIN;
+
+    static int64_t floorDiv(int64_t a, int64_t b) {
+        const int64_t q = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+    }
 
-    struct ServerAgg {
-        int64_t count = 0;
-        int64_t publicCount = 0;
+    static size_t burstSlotOf(int64_t epoch) {
+        return static_cast<size_t>(epoch - floorDiv(epoch, BURST_SLOTS) * BURST_SLOTS);
+    }
+
+    // Per-domain aggregates, struct-of-arrays indexed by interned domain id.
+    // Burst detection keeps BURST_SLOTS sub-window counters per domain instead
+    // of a timestamp queue, so a hot domain never allocates. Ids of domains
+    // that left the window are recycled, so the arrays (and snapshot scans)
+    // stay proportional to live domains under random-label floods.
+    struct DomainAggs {
+        std::vector<uint64_t> hash;
+        std::vector<int64_t> count;
+        std::vector<int64_t> entropySuspicious;
+        std::vector<int64_t> burst;
+        std::vector<int64_t> burstEpoch;
+        std::vector<uint16_t> burstSlots;
+        std::vector<int32_t> listId;
+        std::vector<int32_t> freeIds;
+
+        // Returns a recycled id or appends a new one, with zeroed aggregates.
+        int32_t acquire() {
+            if (!freeIds.empty()) {
+                const int32_t id = freeIds.back();
+                freeIds.pop_back();
+                resetAt(id);
+                return id;
+            }
+            grow();
+            return static_cast<int32_t>(count.size()) - 1;
+        }
+
+        void release(int32_t id) { freeIds.push_back(id); }
+
+        void grow() {
+            hash.push_back(0);
+            count.push_back(0);
+            entropySuspicious.push_back(0);
+            burst.push_back(0);
+            burstEpoch.push_back(BURST_EPOCH_NONE);
+            burstSlots.resize(burstSlots.size() + BURST_SLOTS, 0);
+            listId.push_back(LIST_UNKNOWN);
+        }
+
+        // Reinitializes a recycled id.
+        void resetAt(int32_t id) {
+            hash[id] = 0;
+            count[id] = 0;
+            entropySuspicious[id] = 0;
+            burst[id] = 0;
+            burstEpoch[id] = BURST_EPOCH_NONE;
+            std::fill_n(burstSlots.begin() + static_cast<ptrdiff_t>(id) * BURST_SLOTS, BURST_SLOTS, 0);
+            listId[id] = LIST_UNKNOWN;
+        }
+
+        void clear() {
+            hash.clear();
+            count.clear();
+            entropySuspicious.clear();
+            burst.clear();
+            burstEpoch.clear();
+            burstSlots.clear();
+            listId.clear();
+            freeIds.clear();
+        }
+
+        // Records one query and returns the number of queries seen for this
+        // domain within the last BURST_WINDOW_MS (sub-window granularity).
+        int32_t recordBurst(int32_t id, int64_t tsMs) {
+            uint16_t* slots = burstSlots.data() + static_cast<size_t>(id) * BURST_SLOTS;
+            const int64_t epoch = floorDiv(tsMs, BURST_SLOT_MS);
+            int64_t& last = burstEpoch[id];
+
+            if (last == BURST_EPOCH_NONE || epoch > last) {
+                if (last == BURST_EPOCH_NONE || epoch - last >= BURST_SLOTS) {
+                    std::fill(slots, slots + BURST_SLOTS, 0);
+                } else {
+                    for (int64_t e = last + 1; e <= epoch; e++) slots[burstSlotOf(e)] = 0;
+                }
+                last = epoch;
+            }
+
+            if (last - epoch < BURST_SLOTS) {
+                uint16_t& slot = slots[burstSlotOf(epoch)];
+                if (slot < UINT16_MAX) slot += 1;
+            }
+
+            int32_t sum = 0;
+            for (int32_t i = 0; i < BURST_SLOTS; i++) sum += slots[i];
+            return sum;
+        }
     };
 
-    static constexpr int64_t BURST_WINDOW_MS = 2500;
-    static constexpr int32_t BURST_THRESHOLD = 10;
+    struct ServerAggs {
+        std::vector<int64_t> count;
+        std::vector<int64_t> publicCount;
+
+        void grow() {
+            count.push_back(0);
+            publicCount.push_back(0);
+        }
+
+        void clear() {
+            count.clear();
+            publicCount.clear();
+        }
+    };
 
     static constexpr double ENTROPY_THRESHOLD = 3.60;
     static constexpr int32_t ENTROPY_MIN_LEN = 18;
@@ -43,6 +167,18 @@ namespace {
         return s;
     }
 
+    static uint64_t domainHash(const std::string& domain) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : domain) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
     static std::string jsonEscape(const std::string& in) {
         std::ostringstream o;
         for (char c : in) {
@@ -86,12 +222,47 @@ public:
         serverMap_.clear();
         domainAgg_.clear();
         serverAgg_.clear();
+        activeDomains_ = 0;
+        activeServers_ = 0;
         idToDomain_.clear();
         idToServer_.clear();
+        liveDomainBytes_ = 0;
+        samplingShift_ = 0;
+        std::fill(std::begin(levelEvents_), std::end(levelEvents_), 0);
+        rateWindowStartMs_ = 0;
+        arrivals_ = 0;
+        keptInWindow_ = 0;
+        lastEscalationMs_ = 0;
+        capCutoffMs_ = CAP_CUTOFF_NONE;
         total_ = 0;
         publicDns_ = 0;
         entropySus_ = 0;
         burst_ = 0;
+        std::fill(listHits_.begin(), listHits_.end(), 0);
+        watchlistHits_ = 0;
+    }
+
+    void setBudget(int64_t maxMemoryBytes, int64_t maxEventsPerSec) {
+        std::lock_guard<std::mutex> lg(mu_);
+        maxMemoryBytes_ = std::max<int64_t>(0, maxMemoryBytes);
+        maxEventsPerSec_ = std::max<int64_t>(0, maxEventsPerSec);
+    }
+
+    std::shared_ptr<const DomainWatchlist> setWatchlist(std::shared_ptr<const DomainWatchlist> watchlist) {
+        std::lock_guard<std::mutex> lg(mu_);
+        std::shared_ptr<const DomainWatchlist> prev = std::exchange(watchlist_, std::move(watchlist));
+
+        watchlistCategoryIds_.clear();
+        listed_.assign(idToCategory_.size(), 0);
+        if (watchlist_) {
+            for (int32_t i = 0; i < watchlist_->categoryCount(); i++) {
+                const int32_t id = internCategoryLocked(std::string(watchlist_->categoryName(i)));
+                watchlistCategoryIds_.push_back(id);
+                listed_[id] = 1;
+            }
+        }
+        std::fill(domainAgg_.listId.begin(), domainAgg_.listId.end(), LIST_UNKNOWN);
+        return prev;
     }
 
     void onDns(int64_t tsMs, int32_t, const std::string& qname, int32_t, const std::string& serverIp) {
@@ -103,34 +274,44 @@ public:
         const std::string domain = LeakAnalyzer::normalizeDomain(qname);
         if (domain.empty()) return;
 
+        adjustSamplingLocked(tsMs);
+        const uint64_t hash = domainHash(domain);
+        const uint64_t keepMask = (uint64_t{1} << samplingShift_) - 1;
+        if ((hash & keepMask) != 0) return;
+
+        const int32_t weight = 1 << samplingShift_;
+        keptInWindow_ += 1;
+        levelEvents_[samplingShift_] += 1;
+
         const int32_t dId = internDomainLocked(domain);
+        domainAgg_.hash[dId] = hash;
         const int32_t sId = internServerLocked(serverIp);
 
-        auto& dAgg = domainAgg_[dId];
-        auto& sAgg = serverAgg_[sId];
-
         const bool pub = LeakAnalyzer::isPublicDns(serverIp);
         const bool entropy = LeakAnalyzer::isSuspiciousEntropy(domain);
+        const bool burstNow = domainAgg_.recordBurst(dId, tsMs) >= BURST_THRESHOLD;
 
-        bool burstNow = false;
-        {
-            auto& dq = dAgg.recentTs;
-            dq.push_back(tsMs);
-            while (!dq.empty() && (tsMs - dq.front()) > BURST_WINDOW_MS) dq.pop_front();
-            if (static_cast<int32_t>(dq.size()) >= BURST_THRESHOLD) burstNow = true;
+        int32_t& listId = domainAgg_.listId[dId];
+        if (listId == LIST_UNKNOWN) listId = matchWatchlistLocked(domain);
+        if (listId >= 0) {
+            listHits_[listId] += weight;
+            watchlistHits_ += weight;
         }
 
-        dAgg.count += 1;
-        if (entropy) dAgg.entropySuspicious += 1;
-        if (burstNow) dAgg.burst += 1;
+        // Per-domain aggregates stay exact counts of the kept queries; only the
+        // population totals below are scaled by the inclusion weight.
+        if (domainAgg_.count[dId]++ == 0) activeDomains_ += 1;
+        if (entropy) domainAgg_.entropySuspicious[dId] += 1;
+        if (burstNow) domainAgg_.burst[dId] += 1;
 
-        sAgg.count += 1;
-        if (pub) sAgg.publicCount += 1;
+        if (serverAgg_.count[sId] == 0) activeServers_ += 1;
+        serverAgg_.count[sId] += weight;
+        if (pub) serverAgg_.publicCount[sId] += weight;
 
-        total_ += 1;
-        if (pub) publicDns_ += 1;
-        if (entropy) entropySus_ += 1;
-        if (burstNow) burst_ += 1;
+        total_ += weight;
+        if (pub) publicDns_ += weight;
+        if (entropy) entropySus_ += weight;
+        if (burstNow) burst_ += weight;
 
         events_.push_back(Event{
                 .tsMs = tsMs,
@@ -138,8 +319,27 @@ public:
                 .serverId = sId,
                 .isPublicDns = pub,
                 .isEntropySuspicious = entropy,
-                .isBurst = burstNow
+                .isBurst = burstNow,
+                .listId = listId,
+                .weight = weight
         });
+
+        // Hard cap for when even the maximum shift cannot keep the window in
+        // budget. The cut is reported through effectiveWindowMs/truncated.
+        while (maxMemoryBytes_ > 0 && events_.size() > 1 && estimatedBytesLocked() > maxMemoryBytes_) {
+            capCutoffMs_ = std::max(capCutoffMs_, events_.front().tsMs);
+            popOldestLocked();
+        }
+    }
+
+    void onShed(int64_t count) {
+        std::lock_guard<std::mutex> lg(mu_);
+        if (count > 0) arrivals_ += count;
+    }
+
+    int32_t samplingShift() {
+        std::lock_guard<std::mutex> lg(mu_);
+        return samplingShift_;
     }
 
     LeakSnapshot snapshot(int32_t topN) {
@@ -155,9 +355,34 @@ public:
         out.publicDnsQueries = publicDns_;
         out.suspiciousEntropyQueries = entropySus_;
         out.burstQueries = burst_;
-        out.uniqueDomains = static_cast<int32_t>(domainAgg_.size());
+        out.watchlistQueries = watchlistHits_;
+        out.samplingRate = 1.0 / static_cast<double>(1 << samplingShift_);
+        out.truncated = capCutoffMs_ != CAP_CUTOFF_NONE && capCutoffMs_ >= nowMs - windowMs_;
+        out.effectiveWindowMs = out.truncated ? nowMs - capCutoffMs_ : windowMs_;
         out.publicDnsRatio = (total_ <= 0) ? 0.0 : static_cast<double>(publicDns_) / static_cast<double>(total_);
 
+        // Distinct domains: with K the highest shift that still has events in
+        // the window, a domain whose hash has its low K bits clear was kept on
+        // every query, so those domains are a uniform 1/2^K sample. Exact for K = 0.
+        int32_t liveShift = 0;
+        for (int32_t k = MAX_SAMPLING_SHIFT; k > 0; k--) {
+            if (levelEvents_[k] > 0) {
+                liveShift = k;
+                break;
+            }
+        }
+        const uint64_t liveMask = (uint64_t{1} << liveShift) - 1;
+
+        int64_t sampledDomains = 0;
+        std::vector<std::pair<int32_t, int64_t>> dom;
+        dom.reserve(static_cast<size_t>(activeDomains_));
+        for (int32_t id = 0; id < static_cast<int32_t>(domainAgg_.count.size()); id++) {
+            if (domainAgg_.count[id] <= 0) continue;
+            if ((domainAgg_.hash[id] & liveMask) == 0) sampledDomains += 1;
+            dom.emplace_back(id, domainAgg_.count[id]);
+        }
+        out.uniqueDomains = static_cast<int32_t>(std::min<int64_t>(sampledDomains << liveShift, INT32_MAX));
+
         int score = 0;
         score += static_cast<int>(std::round(std::min(1.0, out.publicDnsRatio / 0.50) * 25.0));
 
@@ -171,30 +396,30 @@ public:
         score += static_cast<int>(std::round(std::min(1.0, out.totalQueries / 5000.0) * 15.0));
         out.score = std::min(100, std::max(0, score));
 
-        std::vector<std::pair<int32_t, int64_t>> dom;
-        dom.reserve(domainAgg_.size());
-        for (auto& kv : domainAgg_) dom.emplace_back(kv.first, kv.second.count);
-        std::sort(dom.begin(), dom.end(), [](auto& a, auto& b) { return a.second > b.second; });
+        const auto byCount = [](const auto& a, const auto& b) { return a.second > b.second; };
 
         std::vector<std::pair<int32_t, int64_t>> srv;
-        srv.reserve(serverAgg_.size());
-        for (auto& kv : serverAgg_) srv.emplace_back(kv.first, kv.second.count);
-        std::sort(srv.begin(), srv.end(), [](auto& a, auto& b) { return a.second > b.second; });
+        srv.reserve(static_cast<size_t>(activeServers_));
+        for (int32_t id = 0; id < static_cast<int32_t>(serverAgg_.count.size()); id++) {
+            if (serverAgg_.count[id] > 0) srv.emplace_back(id, serverAgg_.count[id]);
+        }
 
         const int nDom = std::max(0, std::min<int>(topN, static_cast<int>(dom.size())));
         const int nSrv = std::max(0, std::min<int>(topN, static_cast<int>(srv.size())));
 
+        std::partial_sort(dom.begin(), dom.begin() + nDom, dom.end(), byCount);
+        std::partial_sort(srv.begin(), srv.begin() + nSrv, srv.end(), byCount);
+
         out.topDomains.clear();
         out.topDomains.reserve(nDom);
         for (int i = 0; i < nDom; i++) {
             const int32_t id = dom[i].first;
             const auto& name = idToDomain_[id];
-            const auto& agg = domainAgg_[id];
             out.topDomains.push_back(LeakTopDomain{
                     .domain = name,
-                    .count = agg.count,
-                    .entropySuspicious = agg.entropySuspicious,
-                    .burst = agg.burst
+                    .count = domainAgg_.count[id],
+                    .entropySuspicious = domainAgg_.entropySuspicious[id],
+                    .burst = domainAgg_.burst[id]
             });
         }
 
@@ -203,11 +428,20 @@ public:
         for (int i = 0; i < nSrv; i++) {
             const int32_t id = srv[i].first;
             const auto& ip = idToServer_[id];
-            const auto& agg = serverAgg_[id];
             out.topServers.push_back(LeakTopServer{
                     .ip = ip,
-                    .count = agg.count,
-                    .publicCount = agg.publicCount
+                    .count = serverAgg_.count[id],
+                    .publicCount = serverAgg_.publicCount[id]
+            });
+        }
+
+        out.listHits.clear();
+        for (int32_t id = 0; id < static_cast<int32_t>(idToCategory_.size()); id++) {
+            const bool listed = id < static_cast<int32_t>(listed_.size()) && listed_[id];
+            if (!listed && listHits_[id] <= 0) continue;
+            out.listHits.push_back(LeakListHit{
+                    .list = idToCategory_[id],
+                    .hits = listHits_[id]
             });
         }
 
@@ -222,6 +456,21 @@ public:
         json << "\"publicDnsQueries\":" << out.publicDnsQueries << ",";
         json << "\"suspiciousEntropyQueries\":" << out.suspiciousEntropyQueries << ",";
         json << "\"burstQueries\":" << out.burstQueries << ",";
+        json << "\"watchlistQueries\":" << out.watchlistQueries << ",";
+        json << "\"samplingRate\":" << out.samplingRate << ",";
+        json << "\"effectiveWindowMs\":" << out.effectiveWindowMs << ",";
+        json << "\"truncated\":" << (out.truncated ? "true" : "false") << ",";
+
+        json << "\"listHits\":[";
+        for (size_t i = 0; i < out.listHits.size(); i++) {
+            const auto& h = out.listHits[i];
+            if (i) json << ",";
+            json << "{"
+                 << "\"list\":\"" << jsonEscape(h.list) << "\","
+                 << "\"hits\":" << h.hits
+                 << "}";
+        }
+        json << "],";
 
         json << "\"topDomains\":[";
         for (int i = 0; i < nDom; i++) {
@@ -259,56 +508,139 @@ private:
         if (windowMs_ <= 0) return;
         const int64_t cutoff = nowMs - windowMs_;
 
-        while (!events_.empty() && events_.front().tsMs < cutoff) {
-            const Event e = events_.front();
-            events_.pop_front();
+        while (!events_.empty() && events_.front().tsMs < cutoff) popOldestLocked();
+
+        if (total_ < 0) total_ = 0;
+        if (publicDns_ < 0) publicDns_ = 0;
+        if (entropySus_ < 0) entropySus_ = 0;
+        if (burst_ < 0) burst_ = 0;
+    }
+
+    void popOldestLocked() {
+        const Event e = events_.front();
+        events_.pop_front();
 
-            total_ -= 1;
-            if (e.isPublicDns) publicDns_ -= 1;
-            if (e.isEntropySuspicious) entropySus_ -= 1;
-            if (e.isBurst) burst_ -= 1;
+        total_ -= e.weight;
+        if (e.isPublicDns) publicDns_ -= e.weight;
+        if (e.isEntropySuspicious) entropySus_ -= e.weight;
+        if (e.isBurst) burst_ -= e.weight;
+        levelEvents_[std::countr_zero(static_cast<uint32_t>(e.weight))] -= 1;
 
-            auto dIt = domainAgg_.find(e.domainId);
-            if (dIt != domainAgg_.end()) {
-                dIt->second.count -= 1;
-                if (e.isEntropySuspicious) dIt->second.entropySuspicious -= 1;
-                if (e.isBurst) dIt->second.burst -= 1;
+        if (e.isEntropySuspicious) domainAgg_.entropySuspicious[e.domainId] -= 1;
+        if (e.isBurst) domainAgg_.burst[e.domainId] -= 1;
+        if (--domainAgg_.count[e.domainId] == 0) releaseDomainLocked(e.domainId);
 
-                auto& dq = dIt->second.recentTs;
-                while (!dq.empty() && (nowMs - dq.front()) > BURST_WINDOW_MS) dq.pop_front();
+        serverAgg_.count[e.serverId] -= e.weight;
+        if (serverAgg_.count[e.serverId] == 0) activeServers_ -= 1;
+        if (e.isPublicDns) serverAgg_.publicCount[e.serverId] -= e.weight;
 
-                if (dIt->second.count <= 0) domainAgg_.erase(dIt);
-            }
+        if (e.listId >= 0) {
+            listHits_[e.listId] -= e.weight;
+            watchlistHits_ -= e.weight;
+        }
+    }
+
+    int64_t estimatedBytesLocked() const {
+        return static_cast<int64_t>(events_.size() * sizeof(Event)) + liveDomainBytes_;
+    }
+
+    // Smallest shift whose kept rate fits the event budget and whose projected
+    // window footprint (kept rate x window x current bytes per event) fits the
+    // memory budget, both scaled by num/den.
+    int32_t targetShiftLocked(int64_t arrivalsPerSec, int64_t num, int64_t den) const {
+        const int64_t bytesPerEvent = static_cast<int64_t>(sizeof(Event)) +
+                                      liveDomainBytes_ / std::max<int64_t>(1, static_cast<int64_t>(events_.size()));
+        for (int32_t k = 0; k < MAX_SAMPLING_SHIFT; k++) {
+            const int64_t kept = arrivalsPerSec >> k;
+            const bool cpuOk = maxEventsPerSec_ <= 0 || kept * den <= maxEventsPerSec_ * num;
+            const bool memOk = maxMemoryBytes_ <= 0 ||
+                               kept * windowMs_ / 1000 * bytesPerEvent * den <= maxMemoryBytes_ * num;
+            if (cpuOk && memOk) return k;
+        }
+        return MAX_SAMPLING_SHIFT;
+    }
 
-            auto sIt = serverAgg_.find(e.serverId);
-            if (sIt != serverAgg_.end()) {
-                sIt->second.count -= 1;
-                if (e.isPublicDns) sIt->second.publicCount -= 1;
-                if (sIt->second.count <= 0) serverAgg_.erase(sIt);
+    // Called once per arrival before the sampling decision. Each rollover sets
+    // the shift from the measured arrival rate, stepping down only when the
+    // lower shift fits 3/4 of the budget. Within a window only the event
+    // budget escalates, so a sudden flood is cut before the next rollover.
+    void adjustSamplingLocked(int64_t tsMs) {
+        if (rateWindowStartMs_ == 0 || tsMs < rateWindowStartMs_) rateWindowStartMs_ = tsMs;
+
+        const int64_t elapsed = tsMs - rateWindowStartMs_;
+        if (elapsed >= SAMPLING_WINDOW_MS) {
+            const int64_t arrivalsPerSec = arrivals_ * 1000 / elapsed;
+            const int32_t target = targetShiftLocked(arrivalsPerSec, 1, 1);
+            if (target > samplingShift_) {
+                samplingShift_ = target;
+                lastEscalationMs_ = tsMs;
+            } else if (samplingShift_ > 0 && targetShiftLocked(arrivalsPerSec, 3, 4) < samplingShift_) {
+                samplingShift_ -= 1;
             }
+            rateWindowStartMs_ = tsMs;
+            arrivals_ = 0;
+            keptInWindow_ = 0;
         }
+        arrivals_ += 1;
 
-        if (total_ < 0) total_ = 0;
-        if (publicDns_ < 0) publicDns_ = 0;
-        if (entropySus_ < 0) entropySus_ = 0;
-        if (burst_ < 0) burst_ = 0;
+        if (samplingShift_ >= MAX_SAMPLING_SHIFT) return;
+        if (tsMs - lastEscalationMs_ < SAMPLING_COOLDOWN_MS) return;
+
+        if (maxEventsPerSec_ > 0 && keptInWindow_ >= maxEventsPerSec_) {
+            samplingShift_ += 1;
+            lastEscalationMs_ = tsMs;
+            keptInWindow_ = 0;
+        }
     }
 
     int32_t internDomainLocked(const std::string& domain) {
         auto it = domainMap_.find(domain);
         if (it != domainMap_.end()) return it->second;
-        const int32_t id = static_cast<int32_t>(idToDomain_.size());
+
+        const int32_t id = domainAgg_.acquire();
+        if (id == static_cast<int32_t>(idToDomain_.size())) {
+            idToDomain_.push_back(domain);
+        } else {
+            idToDomain_[id] = domain;
+        }
         domainMap_[domain] = id;
-        idToDomain_.push_back(domain);
+        liveDomainBytes_ += static_cast<int64_t>(domain.size()) + DOMAIN_OVERHEAD_BYTES;
+        return id;
+    }
+
+    // Called once a domain has no events left in the window.
+    void releaseDomainLocked(int32_t id) {
+        activeDomains_ -= 1;
+        liveDomainBytes_ -= static_cast<int64_t>(idToDomain_[id].size()) + DOMAIN_OVERHEAD_BYTES;
+        domainMap_.erase(idToDomain_[id]);
+        std::string().swap(idToDomain_[id]);
+        domainAgg_.release(id);
+    }
+
+    int32_t internCategoryLocked(const std::string& name) {
+        auto it = categoryMap_.find(name);
+        if (it != categoryMap_.end()) return it->second;
+        const int32_t id = static_cast<int32_t>(idToCategory_.size());
+        categoryMap_[name] = id;
+        idToCategory_.push_back(name);
+        listHits_.push_back(0);
+        listed_.push_back(0);
         return id;
     }
 
+    int32_t matchWatchlistLocked(const std::string& domain) const {
+        if (!watchlist_) return LIST_NONE;
+        const int32_t category = watchlist_->match(domain);
+        return (category < 0) ? LIST_NONE : watchlistCategoryIds_[category];
+    }
+
     int32_t internServerLocked(const std::string& ip) {
         auto it = serverMap_.find(ip);
         if (it != serverMap_.end()) return it->second;
         const int32_t id = static_cast<int32_t>(idToServer_.size());
         serverMap_[ip] = id;
         idToServer_.push_back(ip);
+        serverAgg_.grow();
         return id;
     }
 
@@ -321,16 +653,37 @@ private:
     std::unordered_map<std::string, int32_t> domainMap_;
     std::unordered_map<std::string, int32_t> serverMap_;
 
-    std::unordered_map<int32_t, DomainAgg> domainAgg_;
-    std::unordered_map<int32_t, ServerAgg> serverAgg_;
+    DomainAggs domainAgg_;
+    ServerAggs serverAgg_;
+    int32_t activeDomains_ = 0;
+    int32_t activeServers_ = 0;
 
     std::vector<std::string> idToDomain_;
     std::vector<std::string> idToServer_;
+    int64_t liveDomainBytes_ = 0;
+
+    int64_t maxMemoryBytes_ = DEFAULT_MAX_MEMORY_BYTES;
+    int64_t maxEventsPerSec_ = DEFAULT_MAX_EVENTS_PER_SEC;
+    int32_t samplingShift_ = 0;
+    int64_t levelEvents_[MAX_SAMPLING_SHIFT + 1] = {0};
+    int64_t rateWindowStartMs_ = 0;
+    int64_t arrivals_ = 0;
+    int64_t keptInWindow_ = 0;
+    int64_t lastEscalationMs_ = 0;
+    int64_t capCutoffMs_ = CAP_CUTOFF_NONE;
 
     int64_t total_ = 0;
     int64_t publicDns_ = 0;
     int64_t entropySus_ = 0;
     int64_t burst_ = 0;
+
+    std::shared_ptr<const DomainWatchlist> watchlist_;
+    std::vector<int32_t> watchlistCategoryIds_;
+    std::unordered_map<std::string, int32_t> categoryMap_;
+    std::vector<std::string> idToCategory_;
+    std::vector<uint8_t> listed_;
+    std::vector<int64_t> listHits_;
+    int64_t watchlistHits_ = 0;
 };
 
 LeakAnalyzer::LeakAnalyzer(int64_t windowMs) : impl_(std::make_unique<LeakAnalyzerImpl>(windowMs)) {}
@@ -341,9 +694,17 @@ LeakAnalyzer& LeakAnalyzer::operator=(LeakAnalyzer&&) noexcept = default;
 
 void LeakAnalyzer::setWindowMs(int64_t windowMs) { impl_->setWindowMs(windowMs); }
 void LeakAnalyzer::reset() { impl_->reset(); }
+void LeakAnalyzer::setBudget(int64_t maxMemoryBytes, int64_t maxEventsPerSec) {
+    impl_->setBudget(maxMemoryBytes, maxEventsPerSec);
+}
+std::shared_ptr<const DomainWatchlist> LeakAnalyzer::setWatchlist(std::shared_ptr<const DomainWatchlist> watchlist) {
+    return impl_->setWatchlist(std::move(watchlist));
+}
 void LeakAnalyzer::onDns(int64_t tsMs, int32_t uid, const std::string& qname, int32_t qtype, const std::string& serverIp) {
     impl_->onDns(tsMs, uid, qname, qtype, serverIp);
 }
+void LeakAnalyzer::onShed(int64_t count) { impl_->onShed(count); }
+int32_t LeakAnalyzer::samplingShift() { return impl_->samplingShift(); }
 LeakSnapshot LeakAnalyzer::snapshot(int32_t topN) { return impl_->snapshot(topN); }
 
 std::string LeakAnalyzer::normalizeDomain(const std::string& qname) {
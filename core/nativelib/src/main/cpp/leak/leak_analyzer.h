@@ -18,6 +18,11 @@ struct LeakTopServer {
     int64_t publicCount = 0;
 };
 
+struct LeakListHit {
+    std::string list;
+    int64_t hits = 0;
+};
+
 struct LeakSnapshot {
     int32_t score = 0;
 
@@ -33,6 +38,21 @@ struct LeakSnapshot {
     int64_t suspiciousEntropyQueries = 0;
     int64_t burstQueries = 0;
 
+    int64_t watchlistQueries = 0;
+    std::vector<LeakListHit> listHits;
+
+    // Fraction of queries currently retained. Query counts above are
+    // reweighted by its inverse and uniqueDomains is estimated from the
+    // sampled domains; topDomains counts are exact for the domains kept.
+    // 1.0 means full fidelity.
+    double samplingRate = 1.0;
+
+    // When the memory budget cannot be met even at the lowest sampling rate,
+    // the oldest events are dropped: `truncated` is set and the counts cover
+    // only the last effectiveWindowMs instead of windowMs.
+    int64_t effectiveWindowMs = 600000;
+    bool truncated = false;
+
     std::vector<LeakTopDomain> topDomains;
     std::vector<LeakTopServer> topServers;
 
@@ -40,6 +60,7 @@ struct LeakSnapshot {
 };
 
 class LeakAnalyzerImpl;
+class DomainWatchlist;
 
 class LeakAnalyzer {
 public:
@@ -55,8 +76,24 @@ public:
     void setWindowMs(int64_t windowMs);
     void reset();
 
+    // Memory (estimated bytes) and CPU (retained events per second) budget;
+    // 0 disables a limit. Above budget, queries are sampled per domain.
+    void setBudget(int64_t maxMemoryBytes, int64_t maxEventsPerSec);
+
+    // Swaps the active watchlist (nullptr clears it) and returns the previous
+    // one. Load the list before calling this, and drop the returned pointer
+    // outside any lock that ingestion waits on, since it may unmap the file.
+    std::shared_ptr<const DomainWatchlist> setWatchlist(std::shared_ptr<const DomainWatchlist> watchlist);
+
     void onDns(int64_t tsMs, int32_t uid, const std::string& qname, int32_t qtype, const std::string& serverIp);
 
+    // Counts queries the caller dropped itself after checking the domain hash
+    // against samplingShift(), so the arrival rate driving the shift stays exact.
+    void onShed(int64_t count);
+
+    // Queries are kept when the low samplingShift() bits of their domain hash are 0.
+    int32_t samplingShift();
+
     LeakSnapshot snapshot(int32_t topN);
 
     static bool isSuspiciousEntropy(const std::string& domain);
@@ -1,12 +1,23 @@
 #include <jni.h>
+#include <android/log.h>
 #include <memory>
 #include <mutex>
 #include <string>
 
+#include "domain_watchlist.h"
 #include "leak_analyzer.h"
 
+#define LOG_TAG "WiredeyeNative"
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN,  LOG_TAG, __VA_ARGS__)
+
+// nativeLoadWatchlist results, mirrored in NativeLeakAnalyzer.
+static constexpr jint WATCHLIST_LOADED = 0;
+static constexpr jint WATCHLIST_INVALID = 1;
+static constexpr jint WATCHLIST_SUPERSEDED = 2;
+
 static std::mutex gMu;
 static std::unique_ptr<LeakAnalyzer> gAnalyzer;
+static int64_t gWatchlistGeneration = 0;
 
 static std::string jstringToStd(JNIEnv* env, jstring s) {
     if (!s) return {};
@@ -16,6 +27,17 @@ static std::string jstringToStd(JNIEnv* env, jstring s) {
     return out;
 }
 
+// Installs `watchlist` unless a newer load/clear has already been applied,
+// in which case it returns false. Requires gMu. On return `watchlist` holds
+// the list to drop once gMu is released (the previous one, or the rejected one).
+static bool installWatchlistLocked(std::shared_ptr<const DomainWatchlist>& watchlist, int64_t generation) {
+    if (generation < gWatchlistGeneration) return false;
+    gWatchlistGeneration = generation;
+    if (!gAnalyzer) gAnalyzer = std::make_unique<LeakAnalyzer>(600000);
+    watchlist = gAnalyzer->setWatchlist(std::move(watchlist));
+    return true;
+}
+
 extern "C" {
 
 JNIEXPORT void JNICALL
@@ -50,6 +72,56 @@ Java_com_muratcangzm_core_leak_NativeLeakAnalyzer_nativeReset(
 }
 
 JNIEXPORT void JNICALL
+Java_com_muratcangzm_core_leak_NativeLeakAnalyzer_nativeSetBudget(
+        JNIEnv*,
+        jobject,
+        jlong maxMemoryBytes,
+        jlong maxEventsPerSec
+) {
+    std::lock_guard<std::mutex> lg(gMu);
+    if (!gAnalyzer) gAnalyzer = std::make_unique<LeakAnalyzer>(600000);
+    gAnalyzer->setBudget(static_cast<int64_t>(maxMemoryBytes), static_cast<int64_t>(maxEventsPerSec));
+}
+
+JNIEXPORT jint JNICALL
+Java_com_muratcangzm_core_leak_NativeLeakAnalyzer_nativeLoadWatchlist(
+        JNIEnv* env,
+        jobject,
+        jstring path,
+        jlong generation
+) {
+    // Map and validate outside gMu so ingestion keeps running during the load.
+    const std::string p = jstringToStd(env, path);
+    std::string error;
+    std::shared_ptr<const DomainWatchlist> watchlist = DomainWatchlist::open(p, &error);
+    if (!watchlist) {
+        LOGW("watchlist %s rejected: %s", p.c_str(), error.c_str());
+        return WATCHLIST_INVALID;
+    }
+
+    bool installed;
+    {
+        std::lock_guard<std::mutex> lg(gMu);
+        installed = installWatchlistLocked(watchlist, static_cast<int64_t>(generation));
+    }
+    return installed ? WATCHLIST_LOADED : WATCHLIST_SUPERSEDED;
+}
+
+JNIEXPORT void JNICALL
+Java_com_muratcangzm_core_leak_NativeLeakAnalyzer_nativeClearWatchlist(
+        JNIEnv*,
+        jobject,
+        jlong generation
+) {
+    std::shared_ptr<const DomainWatchlist> released;
+    {
+        std::lock_guard<std::mutex> lg(gMu);
+        installWatchlistLocked(released, static_cast<int64_t>(generation));
+    }
+}
+
+// Returns the sampling shift after this query, for the caller's pre-check.
+JNIEXPORT jint JNICALL
 Java_com_muratcangzm_core_leak_NativeLeakAnalyzer_nativeOnDns(
         JNIEnv* env,
         jobject,
@@ -57,7 +129,8 @@ Java_com_muratcangzm_core_leak_NativeLeakAnalyzer_nativeOnDns(
         jint uid,
         jstring qname,
         jint qtype,
-        jstring serverIp
+        jstring serverIp,
+        jint shed
 ) {
     std::lock_guard<std::mutex> lg(gMu);
     if (!gAnalyzer) gAnalyzer = std::make_unique<LeakAnalyzer>(600000);
@@ -65,6 +138,7 @@ Java_com_muratcangzm_core_leak_NativeLeakAnalyzer_nativeOnDns(
     const std::string q = jstringToStd(env, qname);
     const std::string ip = jstringToStd(env, serverIp);
 
+    gAnalyzer->onShed(static_cast<int64_t>(shed));
     gAnalyzer->onDns(
             static_cast<int64_t>(tsMs),
             static_cast<int32_t>(uid),
@@ -72,6 +146,7 @@ Java_com_muratcangzm_core_leak_NativeLeakAnalyzer_nativeOnDns(
             static_cast<int32_t>(qtype),
             ip
     );
+    return static_cast<jint>(gAnalyzer->samplingShift());
 }
 
 JNIEXPORT jstring JNICALL
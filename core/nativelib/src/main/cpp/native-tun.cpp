@@ -10,6 +10,8 @@
 #include <vector>
 #include <sys/epoll.h>
 
+#include "stats/traffic_series.h"
+
 #define LOG_TAG "WiredeyeNative"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO,  LOG_TAG, __VA_ARGS__)
 #define LOGW(...) __android_log_print(ANDROID_LOG_WARN,  LOG_TAG, __VA_ARGS__)
@@ -63,6 +65,10 @@ static void loop_read_tun(int tunFd, int mtu, int readTimeoutMs,
 
         if ((outEv.events & EPOLLIN) && outEv.data.fd == tunFd) {
             ssize_t r = read(tunFd, buf.data(), (int) buf.size());
+            if (r > 0) {
+                trafficSeries().onPacket(TrafficSeries::nowMs(),
+                        reinterpret_cast<const uint8_t *>(buf.data()), (size_t) r);
+            }
             if (r > 0 && gListener && gOnBatch) {
                 jbyteArray arr = env->NewByteArray((jsize) r);
                 if (arr) {
@@ -0,0 +1,249 @@
+#include "traffic_series.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+    struct RingSpec {
+        int64_t spanMs;
+        int32_t slots;
+    };
+
+    static constexpr RingSpec RING_SPECS[RESOLUTION_COUNT] = {
+            {1000, 300},
+            {60 * 1000, 180},
+            {60 * 60 * 1000, 168},
+    };
+
+    static constexpr uint8_t PROTO_TCP = 6;
+    static constexpr uint8_t PROTO_UDP = 17;
+    static constexpr uint16_t DNS_PORT = 53;
+
+    static constexpr int64_t EPOCH_NONE = INT64_MIN;
+
+    static int64_t floorDiv(int64_t a, int64_t b) {
+        const int64_t q = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+    }
+
+    // Non-negative ring slot for any epoch, including those before 1970.
+    static size_t slotOf(int64_t epoch, int32_t slots) {
+        return static_cast<size_t>(epoch - floorDiv(epoch, slots) * slots);
+    }
+
+} // namespace
+
+TrafficSeries::TrafficSeries() {
+    for (int32_t r = 0; r < RESOLUTION_COUNT; r++) {
+        Ring& ring = rings_[r];
+        ring.spanMs = RING_SPECS[r].spanMs;
+        ring.slots = RING_SPECS[r].slots;
+        ring.epochs.assign(ring.slots, EPOCH_NONE);
+        ring.values.assign(static_cast<size_t>(ring.slots) * METRIC_COUNT, 0);
+    }
+}
+
+void TrafficSeries::reset() {
+    std::lock_guard<std::mutex> lg(mu_);
+    for (Ring& ring : rings_) {
+        ring.latestEpoch = EPOCH_NONE;
+        std::fill(ring.epochs.begin(), ring.epochs.end(), EPOCH_NONE);
+        std::fill(ring.values.begin(), ring.values.end(), 0);
+    }
+    std::fill(std::begin(totals_), std::end(totals_), 0);
+}
+
+void TrafficSeries::onPacket(int64_t tsMs, const uint8_t* data, size_t len) {
+    if (!data || len < 1) return;
+
+    int64_t deltas[METRIC_COUNT] = {0};
+    deltas[METRIC_BYTES] = static_cast<int64_t>(len);
+    deltas[METRIC_PACKETS] = 1;
+
+    const uint8_t version = data[0] >> 4;
+    uint8_t proto = 0;
+    size_t l4 = 0;
+    if (version == 4 && len >= 20) {
+        proto = data[9];
+        l4 = static_cast<size_t>(data[0] & 0x0F) * 4;
+    } else if (version == 6 && len >= 40) {
+        proto = data[6];
+        l4 = 40;
+    }
+
+    if (proto == PROTO_TCP) {
+        deltas[METRIC_TCP_PACKETS] = 1;
+    } else if (proto == PROTO_UDP) {
+        deltas[METRIC_UDP_PACKETS] = 1;
+        if (l4 + 4 <= len) {
+            const uint16_t dstPort = static_cast<uint16_t>((data[l4 + 2] << 8) | data[l4 + 3]);
+            if (dstPort == DNS_PORT) deltas[METRIC_DNS_QUERIES] = 1;
+        }
+    } else {
+        deltas[METRIC_OTHER_PACKETS] = 1;
+    }
+
+    add(tsMs, deltas);
+}
+
+void TrafficSeries::add(int64_t tsMs, const int64_t (&deltas)[METRIC_COUNT]) {
+    std::lock_guard<std::mutex> lg(mu_);
+    for (int32_t m = 0; m < METRIC_COUNT; m++) totals_[m] += deltas[m];
+    for (Ring& ring : rings_) {
+        const int64_t epoch = floorDiv(tsMs, ring.spanMs);
+        if (ring.latestEpoch != EPOCH_NONE && epoch <= ring.latestEpoch - ring.slots) continue;
+
+        const size_t slot = slotOf(epoch, ring.slots);
+        int64_t* values = ring.values.data() + slot * METRIC_COUNT;
+        if (ring.epochs[slot] != epoch) {
+            ring.epochs[slot] = epoch;
+            std::fill(values, values + METRIC_COUNT, 0);
+        }
+        for (int32_t m = 0; m < METRIC_COUNT; m++) values[m] += deltas[m];
+        ring.latestEpoch = std::max(ring.latestEpoch, epoch);
+    }
+}
+
+double TrafficSeries::rate(int32_t metric, int64_t nowMs, int64_t windowMs) {
+    if (metric < 0 || metric >= METRIC_COUNT) return 0.0;
+
+    std::lock_guard<std::mutex> lg(mu_);
+    const Ring& ring = rings_[RESOLUTION_SECOND];
+    const int64_t seconds = std::clamp<int64_t>(windowMs / ring.spanMs, 1, ring.slots - 1);
+    const int64_t current = floorDiv(nowMs, ring.spanMs);
+
+    int64_t sum = 0;
+    for (int64_t epoch = current - seconds; epoch < current; epoch++) {
+        const size_t slot = slotOf(epoch, ring.slots);
+        if (ring.epochs[slot] == epoch) sum += ring.values[slot * METRIC_COUNT + metric];
+    }
+    return static_cast<double>(sum) / static_cast<double>(seconds);
+}
+
+int64_t TrafficSeries::total(int32_t metric) {
+    if (metric < 0 || metric >= METRIC_COUNT) return 0;
+    std::lock_guard<std::mutex> lg(mu_);
+    return totals_[metric];
+}
+
+int32_t TrafficSeries::pickResolutionLocked(int64_t fromMs) const {
+    for (int32_t r = 0; r < RESOLUTION_COUNT; r++) {
+        const Ring& ring = rings_[r];
+        if (ring.latestEpoch == EPOCH_NONE) return r;
+        const int64_t oldest = (ring.latestEpoch - ring.slots + 1) * ring.spanMs;
+        if (fromMs >= oldest) return r;
+    }
+    return RESOLUTION_COUNT - 1;
+}
+
+TrafficSeriesResult TrafficSeries::query(int32_t metric, int32_t resolution, int64_t fromMs, int64_t toMs, int32_t maxPoints) {
+    TrafficSeriesResult out;
+    out.metric = std::clamp<int32_t>(metric, 0, METRIC_COUNT - 1);
+
+    std::vector<TrafficPoint> raw;
+    {
+        std::lock_guard<std::mutex> lg(mu_);
+        const int32_t r = (resolution < 0 || resolution >= RESOLUTION_COUNT)
+                          ? pickResolutionLocked(fromMs)
+                          : resolution;
+        const Ring& ring = rings_[r];
+        out.bucketMs = ring.spanMs;
+
+        if (ring.latestEpoch != EPOCH_NONE && fromMs <= toMs) {
+            const int64_t first = std::max(floorDiv(fromMs, ring.spanMs), ring.latestEpoch - ring.slots + 1);
+            const int64_t last = std::min(floorDiv(toMs, ring.spanMs), ring.latestEpoch);
+            if (first <= last) raw.reserve(static_cast<size_t>(last - first + 1));
+            for (int64_t epoch = first; epoch <= last; epoch++) {
+                const size_t slot = slotOf(epoch, ring.slots);
+                const int64_t v = (ring.epochs[slot] == epoch) ? ring.values[slot * METRIC_COUNT + out.metric] : 0;
+                raw.push_back(TrafficPoint{.tsMs = epoch * ring.spanMs, .value = v});
+            }
+        }
+    }
+
+    out.points = downsampleLttb(raw, maxPoints);
+
+    std::ostringstream json;
+    json << "{";
+    json << "\"metric\":" << out.metric << ",";
+    json << "\"bucketMs\":" << out.bucketMs << ",";
+    json << "\"points\":[";
+    for (size_t i = 0; i < out.points.size(); i++) {
+        if (i) json << ",";
+        json << "{\"t\":" << out.points[i].tsMs << ",\"v\":" << out.points[i].value << "}";
+    }
+    json << "]";
+    json << "}";
+
+    out.json = json.str();
+    return out;
+}
+
+int64_t TrafficSeries::nowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// Largest-Triangle-Three-Buckets: keeps the first and last points and, for
+// each bucket in between, the point forming the largest triangle with the
+// previously kept point and the next bucket's average.
+std::vector<TrafficPoint> TrafficSeries::downsampleLttb(const std::vector<TrafficPoint>& in, int32_t threshold) {
+    const size_t n = in.size();
+    if (threshold <= 0 || n <= static_cast<size_t>(threshold)) return in;
+    if (threshold == 1) return {in.back()};
+    if (threshold == 2) return {in.front(), in.back()};
+
+    std::vector<TrafficPoint> out;
+    out.reserve(threshold);
+    out.push_back(in.front());
+
+    const double every = static_cast<double>(n - 2) / static_cast<double>(threshold - 2);
+    size_t a = 0;
+
+    for (int32_t i = 0; i < threshold - 2; i++) {
+        const size_t avgStart = static_cast<size_t>(std::floor((i + 1) * every)) + 1;
+        const size_t avgEnd = std::min(static_cast<size_t>(std::floor((i + 2) * every)) + 1, n);
+
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for (size_t j = avgStart; j < avgEnd; j++) {
+            avgX += static_cast<double>(in[j].tsMs);
+            avgY += static_cast<double>(in[j].value);
+        }
+        const double avgLen = static_cast<double>(std::max<size_t>(1, avgEnd - avgStart));
+        avgX /= avgLen;
+        avgY /= avgLen;
+
+        const size_t rangeStart = static_cast<size_t>(std::floor(i * every)) + 1;
+        const size_t rangeEnd = static_cast<size_t>(std::floor((i + 1) * every)) + 1;
+
+        const double ax = static_cast<double>(in[a].tsMs);
+        const double ay = static_cast<double>(in[a].value);
+
+        double maxArea = -1.0;
+        size_t next = rangeStart;
+        for (size_t j = rangeStart; j < rangeEnd; j++) {
+            const double area = std::fabs(
+                    (ax - avgX) * (static_cast<double>(in[j].value) - ay) -
+                    (ax - static_cast<double>(in[j].tsMs)) * (avgY - ay));
+            if (area > maxArea) {
+                maxArea = area;
+                next = j;
+            }
+        }
+
+        out.push_back(in[next]);
+        a = next;
+    }
+
+    out.push_back(in.back());
+    return out;
+}
+
+TrafficSeries& trafficSeries() {
+    static TrafficSeries instance;
+    return instance;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum TrafficMetric : int32_t {
+    METRIC_BYTES = 0,
+    METRIC_PACKETS = 1,
+    METRIC_DNS_QUERIES = 2,
+    METRIC_TCP_PACKETS = 3,
+    METRIC_UDP_PACKETS = 4,
+    METRIC_OTHER_PACKETS = 5,
+    METRIC_COUNT = 6
+};
+
+enum TrafficResolution : int32_t {
+    RESOLUTION_AUTO = -1,
+    RESOLUTION_SECOND = 0,
+    RESOLUTION_MINUTE = 1,
+    RESOLUTION_HOUR = 2,
+    RESOLUTION_COUNT = 3
+};
+
+struct TrafficPoint {
+    int64_t tsMs = 0;
+    int64_t value = 0;
+};
+
+struct TrafficSeriesResult {
+    int32_t metric = METRIC_BYTES;
+    int64_t bucketMs = 0;
+    std::vector<TrafficPoint> points;
+
+    std::string json;
+};
+
+// Fixed-memory, multi-resolution counters for the TUN reader thread.
+// Each resolution is a ring of buckets (5 min of seconds, 3 h of minutes,
+// 7 d of hours); all memory is allocated once at construction.
+class TrafficSeries {
+public:
+    TrafficSeries();
+
+    TrafficSeries(const TrafficSeries&) = delete;
+    TrafficSeries& operator=(const TrafficSeries&) = delete;
+
+    void reset();
+
+    // Classifies a raw IPv4/IPv6 packet and adds it to every resolution.
+    void onPacket(int64_t tsMs, const uint8_t* data, size_t len);
+    void add(int64_t tsMs, const int64_t (&deltas)[METRIC_COUNT]);
+
+    // Average per-second rate over the complete seconds in (nowMs - windowMs, nowMs].
+    double rate(int32_t metric, int64_t nowMs, int64_t windowMs);
+
+    // Cumulative count since construction or the last reset().
+    int64_t total(int32_t metric);
+
+    // Bucketed series for [fromMs, toMs], reduced with LTTB to at most
+    // maxPoints (<= 0 means no limit; 1 keeps the latest point, 2 the ends).
+    TrafficSeriesResult query(int32_t metric, int32_t resolution, int64_t fromMs, int64_t toMs, int32_t maxPoints);
+
+    static int64_t nowMs();
+    static std::vector<TrafficPoint> downsampleLttb(const std::vector<TrafficPoint>& in, int32_t threshold);
+
+private:
+    struct Ring {
+        int64_t spanMs = 0;
+        int32_t slots = 0;
+        int64_t latestEpoch = INT64_MIN; // INT64_MIN = empty ring
+        std::vector<int64_t> epochs;
+        std::vector<int64_t> values;
+    };
+
+    int32_t pickResolutionLocked(int64_t fromMs) const;
+
+    std::mutex mu_;
+    Ring rings_[RESOLUTION_COUNT];
+    int64_t totals_[METRIC_COUNT] = {0};
+};
+
+// Process-wide instance shared by the TUN reader thread and the JNI bridge.
+TrafficSeries& trafficSeries();
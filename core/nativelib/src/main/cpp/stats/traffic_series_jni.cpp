@@ -0,0 +1,58 @@
+#include <jni.h>
+
+#include "traffic_series.h"
+
+extern "C" {
+
+JNIEXPORT void JNICALL
+Java_com_muratcangzm_core_NativeTrafficSeries_nativeReset(
+        JNIEnv*,
+        jclass
+) {
+    trafficSeries().reset();
+}
+
+JNIEXPORT jdouble JNICALL
+Java_com_muratcangzm_core_NativeTrafficSeries_nativeRate(
+        JNIEnv*,
+        jclass,
+        jint metric,
+        jlong windowMs
+) {
+    return trafficSeries().rate(
+            static_cast<int32_t>(metric),
+            TrafficSeries::nowMs(),
+            static_cast<int64_t>(windowMs)
+    );
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_muratcangzm_core_NativeTrafficSeries_nativeTotal(
+        JNIEnv*,
+        jclass,
+        jint metric
+) {
+    return static_cast<jlong>(trafficSeries().total(static_cast<int32_t>(metric)));
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_muratcangzm_core_NativeTrafficSeries_nativeQueryJson(
+        JNIEnv* env,
+        jclass,
+        jint metric,
+        jint resolution,
+        jlong fromMs,
+        jlong toMs,
+        jint maxPoints
+) {
+    TrafficSeriesResult result = trafficSeries().query(
+            static_cast<int32_t>(metric),
+            static_cast<int32_t>(resolution),
+            static_cast<int64_t>(fromMs),
+            static_cast<int64_t>(toMs),
+            static_cast<int32_t>(maxPoints)
+    );
+    return env->NewStringUTF(result.json.c_str());
+}
+
+}
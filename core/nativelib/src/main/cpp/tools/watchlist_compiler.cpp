@@ -0,0 +1,59 @@
+// Host-side tool: compiles domain lists into the memory-mappable watchlist
+// format read by DomainWatchlist.
+//
+//   wiredeye_watchlist_compiler <out.bin> <category>=<list.txt> [<category>=<list.txt> ...]
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../leak/domain_watchlist.h"
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <out.bin> <category>=<list.txt> [...]\n", argv[0]);
+        return 2;
+    }
+
+    DomainWatchlistBuilder builder;
+    for (int i = 2; i < argc; i++) {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        if (eq == std::string::npos || eq == 0) {
+            std::fprintf(stderr, "bad list argument: %s\n", arg.c_str());
+            return 2;
+        }
+
+        const int32_t category = builder.addCategory(arg.substr(0, eq));
+        if (category < 0) {
+            std::fprintf(stderr, "too many categories\n");
+            return 1;
+        }
+
+        std::ifstream in(arg.substr(eq + 1));
+        if (!in) {
+            std::fprintf(stderr, "cannot read %s\n", arg.c_str() + eq + 1);
+            return 1;
+        }
+
+        std::string line;
+        std::vector<WatchlistRule> rules;
+        while (std::getline(in, line)) {
+            rules.clear();
+            parseWatchlistRules(line, rules);
+            for (const auto& rule : rules) builder.addRule(category, rule);
+        }
+    }
+
+    const std::vector<uint8_t> bytes = builder.build();
+    std::ofstream out(argv[1], std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", argv[1]);
+        return 1;
+    }
+
+    std::printf("%lld rules, %zu bytes\n", static_cast<long long>(builder.ruleCount()), bytes.size());
+    return 0;
+}
@@ -0,0 +1,67 @@
+package com.muratcangzm.core
+
+import androidx.annotation.Keep
+import com.muratcangzm.shared.model.traffic.TrafficSeries
+import kotlinx.serialization.json.Json
+
+/**
+ * Fixed-memory traffic counters fed by the native TUN reader thread.
+ * Buckets are kept per second (5 min), per minute (3 h) and per hour (7 d).
+ */
+@Keep
+object NativeTrafficSeries {
+
+    const val METRIC_BYTES = 0
+    const val METRIC_PACKETS = 1
+    const val METRIC_DNS_QUERIES = 2
+    const val METRIC_TCP_PACKETS = 3
+    const val METRIC_UDP_PACKETS = 4
+    const val METRIC_OTHER_PACKETS = 5
+
+    const val RESOLUTION_AUTO = -1
+    const val RESOLUTION_SECOND = 0
+    const val RESOLUTION_MINUTE = 1
+    const val RESOLUTION_HOUR = 2
+
+    private val json = Json {
+        ignoreUnknownKeys = true
+        isLenient = true
+        explicitNulls = false
+    }
+
+    @JvmStatic external fun nativeReset()
+    @JvmStatic external fun nativeRate(metric: Int, windowMs: Long): Double
+    @JvmStatic external fun nativeTotal(metric: Int): Long
+    @JvmStatic external fun nativeQueryJson(
+        metric: Int,
+        resolution: Int,
+        fromMs: Long,
+        toMs: Long,
+        maxPoints: Int
+    ): String
+
+    fun reset() = nativeReset()
+
+    /** Average per-second rate over the last [windowMs] of complete seconds. */
+    fun rate(metric: Int, windowMs: Long): Double = nativeRate(metric, windowMs)
+
+    /** Cumulative count since the library was loaded or last [reset]. */
+    fun total(metric: Int): Long = nativeTotal(metric)
+
+    /** Bucketed series downsampled (LTTB) to at most [maxPoints] points. */
+    fun query(
+        metric: Int,
+        fromMs: Long,
+        toMs: Long = System.currentTimeMillis(),
+        maxPoints: Int = 120,
+        resolution: Int = RESOLUTION_AUTO
+    ): TrafficSeries {
+        val raw = nativeQueryJson(metric, resolution, fromMs, toMs, maxPoints)
+        return runCatching { json.decodeFromString(TrafficSeries.serializer(), raw) }
+            .getOrDefault(TrafficSeries(metric = metric))
+    }
+
+    init {
+        System.loadLibrary("wiredeye_native")
+    }
+}
@@ -0,0 +1,34 @@
+package com.muratcangzm.core.leak
+
+import android.content.Context
+import java.io.File
+import java.io.FileNotFoundException
+
+// The watchlist compiled at build time from src/main/watchlists (see the
+// compileWatchlists task) ships as an asset. Native code memory-maps it, so it
+// is extracted to a plain file first.
+object BundledWatchlist {
+
+    const val ASSET_NAME = "watchlist.bin"
+
+    // Returns the extracted file, or null when the build bundled no lists.
+    // Blocking; call off the main thread.
+    fun extract(context: Context): File? {
+        val target = File(context.noBackupFilesDir, ASSET_NAME)
+        val temp = File(context.noBackupFilesDir, "$ASSET_NAME.tmp")
+        try {
+            context.assets.open(ASSET_NAME).use { input ->
+                temp.outputStream().use { output -> input.copyTo(output) }
+            }
+        } catch (_: FileNotFoundException) {
+            return null
+        }
+        // Rename rather than overwrite: a previously loaded list may still be
+        // mapped, and truncating its file would fault the reader.
+        if (!temp.renameTo(target)) {
+            temp.delete()
+            return null
+        }
+        return target
+    }
+}
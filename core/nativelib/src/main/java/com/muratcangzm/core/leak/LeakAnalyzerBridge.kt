@@ -1,5 +1,6 @@
 package com.muratcangzm.core.leak
 
+import android.util.Log
 import com.muratcangzm.shared.model.leak.LeakSnapshot
 import kotlinx.coroutines.CoroutineDispatcher
 import kotlinx.coroutines.CoroutineScope
@@ -17,12 +18,16 @@ import kotlinx.coroutines.sync.Mutex
 import kotlinx.coroutines.sync.withLock
 import kotlinx.serialization.json.Json
 import java.io.Closeable
+import java.util.concurrent.atomic.AtomicInteger
 import java.util.concurrent.atomic.AtomicLong
 
 interface LeakAnalyzerBridge : Closeable {
     val snapshot: StateFlow<LeakSnapshot>
     fun setWindowMillis(windowMillis: Long)
     fun reset()
+    fun setBudget(maxMemoryBytes: Long, maxEventsPerSecond: Long)
+    fun loadWatchlist(path: String)
+    fun clearWatchlist()
     fun onDns(timestampMillis: Long, userIdentifier: Int, queryName: String, queryType: Int, serverIp: String)
     fun emitSnapshot(force: Boolean = false)
 }
@@ -49,6 +54,18 @@ class LeakAnalyzerBridgeImpl(
 
     private val lastEmitMillis = AtomicLong(0L)
 
+    // Taken at call time so the most recent load/clear wins, however long
+    // an earlier load spends mapping and validating its file.
+    private val watchlistGeneration = AtomicLong(0L)
+
+    // Native sampling shift as of the last forwarded query. Queries it would
+    // drop are shed here, before the coroutine and JNI crossing; the count is
+    // handed to native with the next forwarded query.
+    @Volatile
+    private var samplingShift = 0
+    private val shedCount = AtomicInteger(0)
+    private val lastForwardMillis = AtomicLong(0L)
+
     private val snapshotRequests = MutableSharedFlow<Boolean>(
         replay = 0,
         extraBufferCapacity = 64,
@@ -95,16 +112,66 @@ class LeakAnalyzerBridgeImpl(
             nativeMutex.withLock {
                 analyzer.nativeReset()
             }
+            samplingShift = 0
+            shedCount.set(0)
             val w = mutableSnapshot.value.windowMs
             mutableSnapshot.value = LeakSnapshot(windowMs = w)
             snapshotRequests.tryEmit(true)
         }
     }
 
-    override fun onDns(timestampMillis: Long, userIdentifier: Int, queryName: String, queryType: Int, serverIp: String) {
+    override fun setBudget(maxMemoryBytes: Long, maxEventsPerSecond: Long) {
         scope.launch {
             nativeMutex.withLock {
-                analyzer.nativeOnDns(timestampMillis, userIdentifier, queryName, queryType, serverIp)
+                analyzer.nativeSetBudget(maxMemoryBytes.coerceAtLeast(0L), maxEventsPerSecond.coerceAtLeast(0L))
+            }
+        }
+    }
+
+    override fun loadWatchlist(path: String) {
+        val generation = watchlistGeneration.incrementAndGet()
+        scope.launch {
+            // Not under nativeMutex: the file is mapped natively without blocking onDns.
+            when (analyzer.nativeLoadWatchlist(path, generation)) {
+                NativeLeakAnalyzer.WATCHLIST_LOADED -> snapshotRequests.tryEmit(true)
+                NativeLeakAnalyzer.WATCHLIST_SUPERSEDED -> Log.i(TAG, "watchlist superseded by a newer load/clear: $path")
+                else -> Log.w(TAG, "watchlist rejected (reason in native log): $path")
+            }
+        }
+    }
+
+    override fun clearWatchlist() {
+        val generation = watchlistGeneration.incrementAndGet()
+        scope.launch {
+            nativeMutex.withLock {
+                analyzer.nativeClearWatchlist(generation)
+            }
+            snapshotRequests.tryEmit(true)
+        }
+    }
+
+    override fun onDns(timestampMillis: Long, userIdentifier: Int, queryName: String, queryType: Int, serverIp: String) {
+        // Still forward one query per interval so native sees the rate and can relax.
+        val shift = samplingShift
+        if (shift > 0 &&
+            !LeakSampling.keeps(queryName, shift) &&
+            timestampMillis - lastForwardMillis.get() < SHED_FORWARD_INTERVAL_MS
+        ) {
+            shedCount.incrementAndGet()
+            return
+        }
+        lastForwardMillis.set(timestampMillis)
+
+        scope.launch {
+            samplingShift = nativeMutex.withLock {
+                analyzer.nativeOnDns(
+                    timestampMillis,
+                    userIdentifier,
+                    queryName,
+                    queryType,
+                    serverIp,
+                    shedCount.getAndSet(0)
+                )
             }
             snapshotRequests.tryEmit(false)
         }
@@ -121,4 +188,9 @@ class LeakAnalyzerBridgeImpl(
             }
         }
     }
+
+    private companion object {
+        const val TAG = "LeakAnalyzerBridge"
+        const val SHED_FORWARD_INTERVAL_MS = 1_000L
+    }
 }
@@ -0,0 +1,42 @@
+package com.muratcangzm.core.leak
+
+// Kotlin mirror of LeakAnalyzer::normalizeDomain + domainHash (leak_analyzer.cpp),
+// used to shed queries the native sampler would drop without crossing JNI.
+// Both must change together.
+internal object LeakSampling {
+
+    private const val FNV_OFFSET = 1469598103934665603L
+    private const val FNV_PRIME = 1099511628211L
+    private const val FMIX_MULTIPLIER = -0x00AE502812AA7333L // 0xff51afd7ed558ccd
+
+    // True when native would keep the query at `shift`, or when the name
+    // cannot be hashed here (non-ASCII, empty) and native has to decide.
+    fun keeps(queryName: String, shift: Int): Boolean {
+        if (shift <= 0) return true
+        val hash = domainHash(queryName) ?: return true
+        return (hash and ((1L shl shift) - 1L)) == 0L
+    }
+
+    fun domainHash(queryName: String): Long? {
+        var end = queryName.length
+        while (end > 0 && queryName[end - 1] == '.') end--
+        if (end < 2) return null
+
+        var h = FNV_OFFSET
+        var length = 0
+        for (i in 0 until end) {
+            var c = queryName[i].code
+            if (c >= 0x80) return null
+            if (c <= 0x20) continue
+            if (c in 'A'.code..'Z'.code) c += 'a'.code - 'A'.code
+            h = (h xor c.toLong()) * FNV_PRIME
+            length++
+        }
+        if (length == 0) return null
+
+        h = h xor (h ushr 33)
+        h *= FMIX_MULTIPLIER
+        h = h xor (h ushr 33)
+        return h
+    }
+}
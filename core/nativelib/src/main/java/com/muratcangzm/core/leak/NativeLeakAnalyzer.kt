@@ -5,10 +5,18 @@ class NativeLeakAnalyzer {
     external fun nativeInit(windowMs: Long)
     external fun nativeSetWindowMs(windowMs: Long)
     external fun nativeReset()
-    external fun nativeOnDns(tsMs: Long, uid: Int, qname: String, qtype: Int, serverIp: String)
+    external fun nativeSetBudget(maxMemoryBytes: Long, maxEventsPerSec: Long)
+    external fun nativeLoadWatchlist(path: String, generation: Long): Int
+    external fun nativeClearWatchlist(generation: Long)
+    external fun nativeOnDns(tsMs: Long, uid: Int, qname: String, qtype: Int, serverIp: String, shed: Int): Int
     external fun nativeSnapshotJson(topN: Int): String
 
     companion object {
+        // nativeLoadWatchlist results; keep in sync with leak_analyzer_jni.cpp.
+        const val WATCHLIST_LOADED = 0
+        const val WATCHLIST_INVALID = 1
+        const val WATCHLIST_SUPERSEDED = 2
+
         init {
             System.loadLibrary("wiredeye_native")
         }
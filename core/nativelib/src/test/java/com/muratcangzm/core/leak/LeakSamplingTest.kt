@@ -0,0 +1,57 @@
+package com.muratcangzm.core.leak
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertNull
+import org.junit.Assert.assertTrue
+import org.junit.Test
+
+/**
+ * LeakSampling must reproduce LeakAnalyzer::normalizeDomain + domainHash from
+ * leak_analyzer.cpp bit for bit, or the bridge sheds queries native would keep.
+ * Expected values were generated from the C++ implementation.
+ */
+class LeakSamplingTest {
+
+    @Test
+    fun hash_matchesNative() {
+        assertEquals(-2361200971618450092L, LeakSampling.domainHash("example.com"))
+        assertEquals(-8283193445768345451L, LeakSampling.domainHash("mail.google.com"))
+        assertEquals(-5649320801082038720L, LeakSampling.domainHash("host53.example.org"))
+    }
+
+    @Test
+    fun hash_normalizesCase() {
+        assertEquals(-2361200971618450092L, LeakSampling.domainHash("Example.COM"))
+    }
+
+    @Test
+    fun hash_stripsTrailingDots() {
+        assertEquals(-8283193445768345451L, LeakSampling.domainHash("MAIL.Google.com."))
+        assertEquals(7445509964014290335L, LeakSampling.domainHash("tracker.io.."))
+    }
+
+    @Test
+    fun hash_dropsEmbeddedWhitespace() {
+        assertEquals(-2578794196587525514L, LeakSampling.domainHash("ads. example .com"))
+        assertEquals(-4049473021956648283L, LeakSampling.domainHash("\tcdn.example.net"))
+    }
+
+    @Test
+    fun hash_defersToNative() {
+        assertNull(LeakSampling.domainHash("a."))
+        assertNull(LeakSampling.domainHash(".."))
+        assertNull(LeakSampling.domainHash("bücher.example"))
+        assertNull(LeakSampling.domainHash("пример.рф"))
+    }
+
+    @Test
+    fun keeps_followsLowHashBits() {
+        // example.com: low 6 bits = 20 (0b010100); host53.example.org: low 6 bits = 0.
+        assertTrue(LeakSampling.keeps("example.com", 0))
+        assertTrue(LeakSampling.keeps("example.com", 2))
+        assertFalse(LeakSampling.keeps("example.com", 3))
+        assertTrue(LeakSampling.keeps("host53.example.org", 6))
+        assertTrue(LeakSampling.keeps("bücher.example", 6))
+    }
+}
@@ -13,7 +13,9 @@ import android.os.ParcelFileDescriptor
 import android.util.Log
 import androidx.annotation.RequiresPermission
 import androidx.core.app.NotificationCompat
+import com.muratcangzm.core.NativeTrafficSeries
 import com.muratcangzm.core.NativeTun
+import com.muratcangzm.core.leak.BundledWatchlist
 import com.muratcangzm.core.leak.LeakAnalyzerBridge
 import com.muratcangzm.data.model.meta.DnsMeta
 import com.muratcangzm.data.model.meta.PacketMeta
@@ -46,10 +48,7 @@ class DnsSnifferVpnService : VpnService(), NativeTun.Listener {
     private val ioScope = CoroutineScope(SupervisorJob() + Dispatchers.IO)
 
     private var lastNotifUpdate: Long = 0L
-    private var totalBytes: Long = 0L
-    private var lastStatsWindowStart: Long = 0L
-    private var windowBytes: Long = 0L
-    private var windowPackets: Long = 0L
+    private var totalBytesBase: Long = 0L
 
     @RequiresPermission(Manifest.permission.ACCESS_NETWORK_STATE)
     override fun onStartCommand(intent: Intent?, flags: Int, startId: Int): Int {
@@ -62,7 +61,7 @@ class DnsSnifferVpnService : VpnService(), NativeTun.Listener {
 
         if (tunInterface != null && nativeLayerRunning) {
             updateNotification(
-                totalBytes = totalBytes,
+                totalBytes = currentTotalBytes(),
                 kbs = currentKbs(),
                 pps = currentPps(),
                 mode = "LIVE"
@@ -95,9 +94,8 @@ class DnsSnifferVpnService : VpnService(), NativeTun.Listener {
             return START_NOT_STICKY
         }
 
-        resetWindow()
         updateNotification(
-            totalBytes = totalBytes,
+            totalBytes = currentTotalBytes(),
             kbs = currentKbs(),
             pps = currentPps(),
             mode = "LIVE"
@@ -141,6 +139,8 @@ class DnsSnifferVpnService : VpnService(), NativeTun.Listener {
     }
 
     private fun startNativeLayer(): Boolean {
+        totalBytesBase = NativeTrafficSeries.total(NativeTrafficSeries.METRIC_BYTES)
+        loadBundledWatchlist()
         NativeTun.setListener(this)
         val fd = tunInterface?.detachFd() ?: return false
         nativeLayerRunning = NativeTun.start(
@@ -155,6 +155,14 @@ class DnsSnifferVpnService : VpnService(), NativeTun.Listener {
         return nativeLayerRunning
     }
 
+    private fun loadBundledWatchlist() {
+        ioScope.launch {
+            runCatching { BundledWatchlist.extract(this@DnsSnifferVpnService) }
+                .onSuccess { file -> file?.let { leakAnalyzerBridge.loadWatchlist(it.absolutePath) } }
+                .onFailure { Log.w(TAG, "bundled watchlist extraction failed", it) }
+        }
+    }
+
     private fun stopTun() {
         runCatching { if (nativeLayerRunning) NativeTun.stop() }
         nativeLayerRunning = false
@@ -315,12 +323,8 @@ class DnsSnifferVpnService : VpnService(), NativeTun.Listener {
         eventBus.tryEmit(meta)
         ioScope.launch { packetRepository.recordPacketMeta(meta) }
 
-        totalBytes += meta.bytes
-        windowBytes += meta.bytes
-        windowPackets += 1
-
         updateNotification(
-            totalBytes = totalBytes,
+            totalBytes = currentTotalBytes(),
             kbs = currentKbs(),
             pps = currentPps(),
             mode = "LIVE"
@@ -462,29 +466,15 @@ class DnsSnifferVpnService : VpnService(), NativeTun.Listener {
         return builder.build()
     }
 
-    private fun resetWindow() {
-        lastStatsWindowStart = System.currentTimeMillis()
-        windowBytes = 0L
-        windowPackets = 0L
-    }
+    // Same source as the rates: whole IP packets seen on the TUN device.
+    private fun currentTotalBytes(): Long =
+        (NativeTrafficSeries.total(NativeTrafficSeries.METRIC_BYTES) - totalBytesBase).coerceAtLeast(0L)
 
-    private fun currentKbs(): Double {
-        val now = System.currentTimeMillis()
-        val elapsedMs = (now - lastStatsWindowStart).coerceAtLeast(1L)
-        val seconds = elapsedMs / 1000.0
-        val bytesPerSecond = windowBytes / seconds
-        if (elapsedMs >= STATS_WINDOW_RESET_MS) resetWindow()
-        return bytesPerSecond / 1024.0
-    }
+    private fun currentKbs(): Double =
+        NativeTrafficSeries.rate(NativeTrafficSeries.METRIC_BYTES, RATE_WINDOW_MS) / 1024.0
 
-    private fun currentPps(): Double {
-        val now = System.currentTimeMillis()
-        val elapsedMs = (now - lastStatsWindowStart).coerceAtLeast(1L)
-        val seconds = elapsedMs / 1000.0
-        val packetsPerSecond = windowPackets / seconds
-        if (elapsedMs >= STATS_WINDOW_RESET_MS) resetWindow()
-        return packetsPerSecond
-    }
+    private fun currentPps(): Double =
+        NativeTrafficSeries.rate(NativeTrafficSeries.METRIC_PACKETS, RATE_WINDOW_MS)
 
     private fun format1(v: Double): String = String.format(Locale.getDefault(), "%.1f", v)
 
@@ -511,6 +501,6 @@ class DnsSnifferVpnService : VpnService(), NativeTun.Listener {
         private const val NOTIFICATION_ID = 9001
 
         private const val NOTIF_INTERVAL_MS = 1000L
-        private const val STATS_WINDOW_RESET_MS = 10_000L
+        private const val RATE_WINDOW_MS = 5_000L
     }
 }
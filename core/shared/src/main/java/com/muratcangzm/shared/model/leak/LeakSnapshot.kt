@@ -16,6 +16,11 @@ data class LeakSnapshot(
     @SerialName("publicDnsQueries") val publicDnsQueries: Long = 0L,
     @SerialName("suspiciousEntropyQueries") val suspiciousEntropyQueries: Long = 0L,
     @SerialName("burstQueries") val burstQueries: Long = 0L,
+    @SerialName("watchlistQueries") val watchlistQueries: Long = 0L,
+    @SerialName("listHits") val listHits: List<ListHit> = emptyList(),
+    @SerialName("samplingRate") val samplingRate: Double = 1.0,
+    @SerialName("effectiveWindowMs") val effectiveWindowMs: Long = 600_000L,
+    @SerialName("truncated") val truncated: Boolean = false,
     @SerialName("topDomains") val topDomains: List<TopDomain> = emptyList(),
     @SerialName("topServers") val topServers: List<TopServer> = emptyList()
 )
@@ -34,3 +39,9 @@ data class TopServer(
     @SerialName("count") val count: Long,
     @SerialName("publicCount") val publicCount: Long
 )
+
+@Serializable
+data class ListHit(
+    @SerialName("list") val list: String,
+    @SerialName("hits") val hits: Long
+)
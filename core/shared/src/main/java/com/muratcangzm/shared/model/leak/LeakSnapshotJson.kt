@@ -17,6 +17,11 @@ internal data class LeakSnapshotDto(
     val publicDnsQueries: Long = 0,
     val suspiciousEntropyQueries: Long = 0,
     val burstQueries: Long = 0,
+    val watchlistQueries: Long = 0,
+    val listHits: List<LeakListHitDto> = emptyList(),
+    val samplingRate: Double = 1.0,
+    val effectiveWindowMs: Long = 600_000,
+    val truncated: Boolean = false,
     val topDomains: List<LeakTopDomainDto> = emptyList(),
     val topServers: List<LeakTopServerDto> = emptyList()
 )
@@ -29,6 +34,12 @@ internal data class LeakTopDomainDto(
     val burst: Long
 )
 
+@Serializable
+internal data class LeakListHitDto(
+    val list: String,
+    val hits: Long
+)
+
 @Serializable
 internal data class LeakTopServerDto(
     val ip: String,
@@ -57,6 +68,16 @@ internal object LeakSnapshotJson {
             publicDnsQueries = dto.publicDnsQueries,
             suspiciousEntropyQueries = dto.suspiciousEntropyQueries,
             burstQueries = dto.burstQueries,
+            watchlistQueries = dto.watchlistQueries,
+            listHits = dto.listHits.map {
+                ListHit(
+                    list = it.list,
+                    hits = it.hits
+                )
+            },
+            samplingRate = dto.samplingRate,
+            effectiveWindowMs = dto.effectiveWindowMs,
+            truncated = dto.truncated,
             topDomains = dto.topDomains.map {
                 TopDomain(
                     domain = it.domain,
@@ -0,0 +1,19 @@
+package com.muratcangzm.shared.model.traffic
+
+import androidx.compose.runtime.Immutable
+import kotlinx.serialization.SerialName
+import kotlinx.serialization.Serializable
+
+@Serializable
+@Immutable
+data class TrafficSeries(
+    @SerialName("metric") val metric: Int = 0,
+    @SerialName("bucketMs") val bucketMs: Long = 0L,
+    @SerialName("points") val points: List<TrafficPoint> = emptyList()
+)
+
+@Serializable
+data class TrafficPoint(
+    @SerialName("t") val timestampMs: Long,
+    @SerialName("v") val value: Long
+)